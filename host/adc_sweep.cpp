@@ -0,0 +1,31 @@
+// Runs the ADC benchmark sweep (ADC_DEFAULT_SWEEP) against the synthetic noise model
+//   and prints the same table adc_benchmark() prints on the device.
+//
+// Usage: adc_sweep [noise_lsb16]
+//   noise_lsb16 - input referred noise of the model in 16 bit LSBs (1 sigma), default 6
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "../jjrc_xinput_controller/src/adcBench/adcBench.h"
+
+static void print_line(const char* line) {
+  printf("%s\n", line);
+}
+
+int main(int argc, char** argv) {
+  adcSynth synth;
+  adcBench bench;
+  ADC_PROFILE_T current = {16, 4, ADC_SPEED_MED, ADC_SPEED_MED, 5}; //The sketch's ADC_DEFAULT_PROFILE
+  float noise = 6.0;
+
+  if(argc > 1) {
+    noise = atof(argv[1]);
+  }
+
+  synth.setup(0.5, 0.75, noise);
+  bench.setup(&synth);
+
+  printf("Source: synthetic noise model (%.2f LSB16)\n", noise);
+  bench.sweep(0, current, ADC_DEFAULT_SWEEP, print_line);
+  return 0;
+}
@@ -0,0 +1,24 @@
+// Minimal assertion harness shared by the host tests. Each test is a single
+// translation unit, so the counter lives here.
+
+#ifndef check_h
+#define check_h
+
+#include <stdio.h>
+
+static int check_failures = 0;
+
+#define CHECK(cond) do { \
+    if(!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      check_failures++; \
+    } \
+  } while(0)
+
+//Print the summary line for a test program and return its exit code.
+static inline int check_result(const char* name) {
+  printf("%s: %s\n", name, check_failures == 0 ? "PASS" : "FAIL");
+  return check_failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,137 @@
+// Host tests for src/adcBench, run against the adcSynth noise model.
+
+#include <string.h>
+#include "check.h"
+#include "../jjrc_xinput_controller/src/adcBench/adcBench.h"
+
+#define REST_SAMPLES 256
+
+//Last line printed by a sweep
+static char last_line[ADC_BENCH_LINE_LEN];
+static int line_count = 0;
+
+static void print_line(const char* line) {
+  strncpy(last_line, line, sizeof(last_line) - 1);
+  last_line[sizeof(last_line) - 1] = 0;
+  line_count++;
+}
+
+static bool same_profile(const ADC_PROFILE_T& a, const ADC_PROFILE_T& b) {
+  return a.resolution == b.resolution && a.hw_averaging == b.hw_averaging
+      && a.conv_speed == b.conv_speed && a.samp_speed == b.samp_speed
+      && a.sw_samples == b.sw_samples;
+}
+
+//More hardware or software averaging means less noise at rest.
+static void test_noise() {
+  adcSynth synth;
+  adcBench bench;
+  ADC_PROFILE_T p = {16, 1, ADC_SPEED_MED, ADC_SPEED_MED, 1};
+  float prev;
+  ADC_BENCH_RESULT_T r;
+
+  synth.setup(0.5, 0.75, 6.0);
+  bench.setup(&synth);
+
+  const uint8_t hw[] = {1, 4, 16};
+  prev = 1e9;
+  for(unsigned int i=0; i < sizeof(hw); i++) {
+    p.hw_averaging = hw[i];
+    r = bench.measure(0, p, REST_SAMPLES);
+    CHECK(r.stddev < prev);
+    prev = r.stddev;
+  }
+
+  const uint8_t sw[] = {1, 2, 8};
+  p.hw_averaging = 1;
+  prev = 1e9;
+  for(unsigned int i=0; i < sizeof(sw); i++) {
+    p.sw_samples = sw[i];
+    r = bench.measure(0, p, REST_SAMPLES);
+    CHECK(r.stddev < prev);
+    prev = r.stddev;
+  }
+}
+
+//adcSynth can step its input, so lag is measured and grows with software oversampling.
+static void test_lag() {
+  adcSynth synth;
+  adcBench bench;
+  ADC_PROFILE_T p = {12, 4, ADC_SPEED_HIGH, ADC_SPEED_HIGH, 1};
+  float prev = 0;
+  ADC_BENCH_RESULT_T r;
+
+  synth.setup(0.5, 0.75, 6.0);
+  bench.setup(&synth);
+
+  const uint8_t sw[] = {1, 2, 5, 8};
+  for(unsigned int i=0; i < sizeof(sw); i++) {
+    p.sw_samples = sw[i];
+    r = bench.measure(0, p, REST_SAMPLES);
+    CHECK(r.lag_measured);
+    CHECK(r.lag_us > 0);
+    CHECK(r.lag_us > prev);
+    prev = r.lag_us;
+  }
+}
+
+//The suggestion meets the lag budget, and with an impossible budget the current profile is kept.
+static void test_sweep() {
+  const uint8_t res[] = {12};
+  const uint8_t hw[] = {1, 8};
+  const uint8_t speeds[] = {ADC_SPEED_MED, ADC_SPEED_HIGH};
+  const uint8_t sw[] = {1, 4};
+  ADC_SWEEP_T s = {res, sizeof(res), hw, sizeof(hw), speeds, sizeof(speeds), sw, sizeof(sw),
+                   REST_SAMPLES, 1000000.0};
+  ADC_PROFILE_T current = {16, 4, ADC_SPEED_MED, ADC_SPEED_MED, 5};
+  ADC_PROFILE_T best;
+  ADC_BENCH_RESULT_T r;
+  adcSynth synth;
+  adcBench bench;
+
+  synth.setup(0.5, 0.75, 6.0);
+  bench.setup(&synth);
+
+  line_count = 0;
+  best = bench.sweep(0, current, s, print_line);
+  CHECK(line_count == 1 + 1*2*2*2*2 + 1);
+  CHECK(strncmp(last_line, "Best ENOB", 9) == 0);
+  CHECK(!same_profile(best, current));
+  CHECK(best.hw_averaging == 8 && best.sw_samples == 4); //Most averaging wins with no lag limit
+
+  s.lag_budget_us = 10000.0;
+  best = bench.sweep(0, current, s, print_line);
+  r = bench.measure(0, best, REST_SAMPLES);
+  CHECK(r.lag_us <= s.lag_budget_us);
+
+  s.lag_budget_us = 0.1;
+  best = bench.sweep(0, current, s, print_line);
+  CHECK(strncmp(last_line, "No profile within lag budget", 28) == 0);
+  CHECK(same_profile(best, current));
+}
+
+//Fixed point printing rounds and never prints "-0".
+static void test_format() {
+  char buf[16];
+
+  adcBench::formatFixed(buf, sizeof(buf), 3.14159, 2);
+  CHECK(strcmp(buf, "3.14") == 0);
+  adcBench::formatFixed(buf, sizeof(buf), 0.999, 2);
+  CHECK(strcmp(buf, "1.00") == 0);
+  adcBench::formatFixed(buf, sizeof(buf), -12.26, 1);
+  CHECK(strcmp(buf, "-12.3") == 0);
+  adcBench::formatFixed(buf, sizeof(buf), -0.001, 2);
+  CHECK(strcmp(buf, "0.00") == 0);
+  adcBench::formatFixed(buf, sizeof(buf), 1234.5, 0);
+  CHECK(strcmp(buf, "1235") == 0);
+  CHECK(adcBench::formatFixed(buf, sizeof(buf), 7.05, 1) == 3);
+}
+
+int main() {
+  test_noise();
+  test_lag();
+  test_sweep();
+  test_format();
+
+  return check_result("test_adcBench");
+}
@@ -0,0 +1,83 @@
+// Host tests for src/eventQueue.
+
+#include "check.h"
+#include "../jjrc_xinput_controller/src/eventQueue/eventQueue.h"
+
+//Push/pop far more events than the ring holds so the uint8_t indices wrap several times.
+static void test_wraparound() {
+  eventQueue q;
+  INPUT_EVENT_T e;
+  uint32_t next_pop = 0;
+
+  for(uint32_t i=0; i < 1000; i++) {
+    CHECK(q.push(i, i % 4, i & 1));
+    if(i % 3 == 2) { //Let the ring fill partway before draining
+      while(q.pop(&e)) {
+        CHECK(e.timestamp == next_pop);
+        CHECK(e.source == next_pop % 4);
+        CHECK(e.level == (next_pop & 1));
+        next_pop++;
+      }
+    }
+  }
+  while(q.pop(&e)) {
+    CHECK(e.timestamp == next_pop);
+    next_pop++;
+  }
+  CHECK(next_pop == 1000);
+  CHECK(q.count() == 0);
+  CHECK(q.overflows() == 0);
+}
+
+static void test_overflow() {
+  eventQueue q;
+  INPUT_EVENT_T e;
+
+  for(int i=0; i < EVENT_QUEUE_LEN; i++) {
+    CHECK(q.push(i, 0, 0));
+  }
+  CHECK(q.count() == EVENT_QUEUE_LEN);
+  CHECK(!q.push(100, 0, 0));
+  CHECK(!q.push(101, 0, 0));
+  CHECK(q.overflows() == 2);
+
+  //Oldest events survive, the dropped ones never appear
+  CHECK(q.pop(&e));
+  CHECK(e.timestamp == 0);
+  CHECK(q.push(102, 0, 0));
+  CHECK(q.overflows() == 2);
+  for(int i=1; i < EVENT_QUEUE_LEN; i++) {
+    CHECK(q.pop(&e));
+    CHECK(e.timestamp == (uint32_t)i);
+  }
+  CHECK(q.pop(&e));
+  CHECK(e.timestamp == 102);
+  CHECK(!q.pop(&e));
+}
+
+static void test_peak() {
+  eventQueue q;
+  INPUT_EVENT_T e;
+
+  CHECK(q.peak() == 0);
+  for(int i=0; i < 5; i++) {
+    q.push(i, 0, 0);
+  }
+  CHECK(q.peak() == 5);
+  while(q.pop(&e));
+  q.push(0, 0, 0);
+  CHECK(q.peak() == 5); //Peak holds after draining
+
+  for(int i=0; i < EVENT_QUEUE_LEN + 3; i++) {
+    q.push(i, 0, 0);
+  }
+  CHECK(q.peak() == EVENT_QUEUE_LEN);
+}
+
+int main() {
+  test_wraparound();
+  test_overflow();
+  test_peak();
+
+  return check_result("test_eventQueue");
+}
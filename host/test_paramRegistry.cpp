@@ -0,0 +1,211 @@
+// Host tests for src/paramRegistry.
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include "check.h"
+#include "../jjrc_xinput_controller/src/paramRegistry/paramRegistry.h"
+
+struct TEST_PARAMS_T {
+  float alpha;
+  int32_t tol;
+};
+
+const PARAM_DESC_T descs[] = {
+  {"alpha", PARAM_FLOAT, offsetof(TEST_PARAMS_T, alpha), 0.0, 0.99},
+  {"tol",   PARAM_INT32, offsetof(TEST_PARAMS_T, tol),   0,   1000}
+};
+
+//Last response frame written by the registry
+static uint8_t resp[64];
+static uint8_t resp_len = 0;
+static int resp_count = 0;
+static bool persisted = false;
+
+static void write_resp(const uint8_t* buf, uint8_t len) {
+  memcpy(resp, buf, len);
+  resp_len = len;
+  resp_count++;
+}
+
+static bool persist() {
+  persisted = true;
+  return true;
+}
+
+static void send(paramRegistry& r, uint8_t cmd, const uint8_t* payload, uint8_t len) {
+  uint8_t cksum = cmd ^ len;
+
+  r.receive(PARAM_REQ_SYNC);
+  r.receive(cmd);
+  r.receive(len);
+  for(int i=0; i < len; i++) {
+    r.receive(payload[i]);
+    cksum ^= payload[i];
+  }
+  r.receive(cksum);
+}
+
+static uint32_t raw_float(float f) {
+  uint32_t raw;
+  memcpy(&raw, &f, sizeof(raw));
+  return raw;
+}
+
+//SETs are range checked and only reach the live struct on apply().
+static void test_set_apply() {
+  TEST_PARAMS_T live = {0.7f, 300};
+  TEST_PARAMS_T staged = live;
+  paramRegistry r;
+
+  r.setup(descs, 2, &live, &staged, sizeof(live), write_resp, persist);
+  CHECK(!r.apply());
+  CHECK(r.set(0, raw_float(0.5f)) == PARAM_OK);
+  CHECK(r.set(1, 400) == PARAM_OK);
+  CHECK(live.alpha == 0.7f && live.tol == 300);
+  CHECK(r.apply());
+  CHECK(live.alpha == 0.5f && live.tol == 400);
+
+  CHECK(r.set(0, raw_float(1.5f)) == PARAM_ERR_RANGE);
+  CHECK(r.set(0, raw_float(NAN)) == PARAM_ERR_RANGE);
+  CHECK(r.set(1, (uint32_t)-1) == PARAM_ERR_RANGE);
+  CHECK(r.set(2, 0) == PARAM_ERR_ID);
+  CHECK(!r.apply());
+}
+
+//Loading a stored struct is all or nothing.
+static void test_stage() {
+  TEST_PARAMS_T live = {0.7f, 300};
+  TEST_PARAMS_T staged = live;
+  TEST_PARAMS_T stored = {0.2f, 5000};
+  paramRegistry r;
+
+  r.setup(descs, 2, &live, &staged, sizeof(live), write_resp, persist);
+  CHECK(r.stage(&stored) == PARAM_ERR_RANGE);
+  CHECK(staged.alpha == 0.7f && staged.tol == 300);
+  CHECK(!r.apply());
+
+  stored.tol = 50;
+  CHECK(r.stage(&stored) == PARAM_OK);
+  CHECK(r.apply());
+  CHECK(live.alpha == 0.2f && live.tol == 50);
+}
+
+//Reordering, renaming or retyping fields changes the layout.
+static void test_layout() {
+  const PARAM_DESC_T swapped[] = {
+    {"tol",   PARAM_INT32, offsetof(TEST_PARAMS_T, alpha), 0,   1000},
+    {"alpha", PARAM_FLOAT, offsetof(TEST_PARAMS_T, tol),   0.0, 0.99}
+  };
+  const PARAM_DESC_T renamed[] = {
+    {"alpha", PARAM_FLOAT, offsetof(TEST_PARAMS_T, alpha), 0.0, 0.99},
+    {"tole",  PARAM_INT32, offsetof(TEST_PARAMS_T, tol),   0,   1000}
+  };
+  TEST_PARAMS_T live = {0.7f, 300};
+  TEST_PARAMS_T staged = live;
+  paramRegistry a, b, c;
+
+  a.setup(descs, 2, &live, &staged, sizeof(live), 0, 0);
+  b.setup(swapped, 2, &live, &staged, sizeof(live), 0, 0);
+  c.setup(renamed, 2, &live, &staged, sizeof(live), 0, 0);
+  CHECK(a.layout() != b.layout());
+  CHECK(a.layout() != c.layout());
+  CHECK(a.layout() == a.layout());
+}
+
+//Status values follow the parameters, are readable and can't be set.
+static void test_status() {
+  struct TEST_STATUS_T {
+    int32_t drops;
+  };
+  const PARAM_DESC_T status_descs[] = {
+    {"drops", PARAM_INT32, offsetof(TEST_STATUS_T, drops), 0, 1000}
+  };
+  TEST_PARAMS_T live = {0.7f, 300};
+  TEST_PARAMS_T staged = live;
+  TEST_STATUS_T status = {0};
+  uint32_t layout;
+  uint32_t raw;
+  paramRegistry r;
+
+  r.setup(descs, 2, &live, &staged, sizeof(live), write_resp, persist);
+  layout = r.layout();
+  r.setupStatus(status_descs, 1, &status);
+  CHECK(r.layout() == layout);
+
+  status.drops = 7;
+  CHECK(r.get(2, &raw) == PARAM_OK && raw == 7);
+  CHECK(r.set(2, 0) == PARAM_ERR_READ_ONLY);
+  CHECK(r.get(3, &raw) == PARAM_ERR_ID);
+  CHECK(r.set(3, 0) == PARAM_ERR_ID);
+  CHECK(!r.apply());
+
+  resp_count = 0;
+  send(r, PARAM_CMD_LIST, 0, 0);
+  CHECK(resp_count == 3);
+  CHECK(resp[4] == 2 && memcmp(&resp[18], "drops", 5) == 0);
+}
+
+//Frames: GET/SET/LIST/PERSIST, bad checksum, and the text silencing flag.
+static void test_protocol() {
+  TEST_PARAMS_T live = {0.7f, 300};
+  TEST_PARAMS_T staged = live;
+  paramRegistry r;
+  uint8_t req[5];
+  uint32_t raw;
+
+  r.setup(descs, 2, &live, &staged, sizeof(live), write_resp, persist);
+  CHECK(!r.active());
+
+  //Corrupt checksum: no response, and the link stays available for text
+  resp_count = 0;
+  r.receive(PARAM_REQ_SYNC);
+  r.receive(PARAM_CMD_GET);
+  r.receive(1);
+  r.receive(0);
+  r.receive(0x55);
+  CHECK(resp_count == 0);
+  CHECK(!r.active());
+
+  req[0] = 1;
+  send(r, PARAM_CMD_GET, req, 1);
+  CHECK(resp_count == 1);
+  CHECK(r.active());
+  CHECK(resp_len == 11);
+  CHECK(resp[0] == PARAM_RESP_SYNC && resp[1] == (PARAM_CMD_GET | PARAM_RESP_FLAG));
+  CHECK(resp[3] == PARAM_OK && resp[4] == 1 && resp[5] == PARAM_INT32);
+  memcpy(&raw, &resp[6], sizeof(raw));
+  CHECK(raw == 300);
+
+  req[0] = 1;
+  raw = 2000;
+  memcpy(&req[1], &raw, sizeof(raw));
+  send(r, PARAM_CMD_SET, req, 5);
+  CHECK(resp[3] == PARAM_ERR_RANGE);
+  raw = 20;
+  memcpy(&req[1], &raw, sizeof(raw));
+  send(r, PARAM_CMD_SET, req, 5);
+  CHECK(resp[3] == PARAM_OK);
+  CHECK(staged.tol == 20 && live.tol == 300);
+
+  resp_count = 0;
+  send(r, PARAM_CMD_LIST, 0, 0);
+  CHECK(resp_count == 2);
+  CHECK(resp[2] == 7 + 8 + 3 && memcmp(&resp[18], "tol", 3) == 0);
+
+  send(r, PARAM_CMD_PERSIST, 0, 0);
+  CHECK(persisted && resp[3] == PARAM_OK);
+
+  send(r, 0x7F, 0, 0);
+  CHECK(resp[3] == PARAM_ERR_CMD);
+}
+
+int main() {
+  test_set_apply();
+  test_stage();
+  test_layout();
+  test_status();
+  test_protocol();
+
+  return check_result("test_paramRegistry");
+}
@@ -0,0 +1,71 @@
+// Host tests for src/vDebounce.
+
+#include "check.h"
+#include "../jjrc_xinput_controller/src/vDebounce/vDebounce.h"
+
+//Integrating mode only changes after 'samples' consecutive disagreeing samples.
+static void test_integrating() {
+  vDebounce d;
+
+  d.setup(0x1, 3, false);
+  CHECK(d.update(0x0) == 0);
+  CHECK(d.update(0x1) == 0); //Bounce back resets the count
+  CHECK(d.update(0x0) == 0);
+  CHECK(d.update(0x0) == 0);
+  CHECK(d.update(0x0) == 0x1);
+  CHECK(d.read() == 0x0);
+  CHECK(d.update(0x0) == 0);
+}
+
+//Leading edge mode reports immediately, then ignores bounce for 'samples' updates.
+static void test_leading_edge() {
+  vDebounce d;
+
+  d.setup(0x1, 3, true);
+  CHECK(d.update(0x0) == 0x1);
+  CHECK(d.read() == 0x0);
+  CHECK(d.update(0x1) == 0); //Locked out
+  CHECK(d.update(0x0) == 0);
+  CHECK(d.update(0x1) == 0x1); //Lockout over, release reported straight away
+  CHECK(d.read() == 0x1);
+}
+
+//Every lane is independent.
+static void test_parallel() {
+  vDebounce d;
+  uint32_t changed = 0;
+
+  d.setup(0xFFFFFFFF, 2, false);
+  changed |= d.update(0xFFFF0000);
+  changed |= d.update(0xFFFF0000);
+  CHECK(changed == 0x0000FFFF);
+  CHECK(d.read() == 0xFFFF0000);
+
+  CHECK(d.update(0x0000FFFF) == 0);
+  CHECK(d.update(0x0000FFFF) == 0xFFFFFFFF);
+  CHECK(d.read() == 0x0000FFFF);
+}
+
+//Longest supported debounce and clamping of out of range lengths.
+static void test_samples_range() {
+  vDebounce d;
+  int n = 0;
+
+  d.setup(0x1, 200, false);
+  while(d.update(0x0) == 0) {
+    n++;
+  }
+  CHECK(n == VDEBOUNCE_MAX_SAMPLES - 1);
+
+  d.setup(0x1, 0, false);
+  CHECK(d.update(0x0) == 0x1);
+}
+
+int main() {
+  test_integrating();
+  test_leading_edge();
+  test_parallel();
+  test_samples_range();
+
+  return check_result("test_vDebounce");
+}
@@ -12,18 +12,29 @@
 // - Select yout Teensy board from Tools > Board in Arduino IDE
 // - Select Tools > Usb Type > XInput
 
-#include <Bounce.h>
 #include <EEPROM.h>
 #include <xinput.h>
 
 #include "src/ht1621_LCD/ht1621_LCD.h"
 #include "src/fSevSeg/fSevSeg.h"
+#include "src/eventQueue/eventQueue.h"
+#include "src/vDebounce/vDebounce.h"
+#include "src/adcBench/adcBench.h"
+#include "src/adcBench/teensyAdcSource.h"
+#include "src/paramRegistry/paramRegistry.h"
 
 //DISABLED ANALOG INPUTS
 #define LEFT_STICK_DISABLED false
 #define RIGHT_STICK_DISABLED true
 #define TRIGGER_DISABLED true
 
+//Print every input event (with its timestamp) to HWSERIAL as it's consumed.
+//  Silenced once the parameter protocol is in use (see paramRegistry.h).
+#define EVENT_TELEMETRY false
+
+//Run the ADC benchmark against the synthetic noise model instead of the real inputs
+#define ADC_BENCH_SYNTHETIC false
+
 //Pinouts chosend to try to keep compatible with TeensyLC implementation
 //DIGITAL INPUT PINS
 #define AUX1_PIN 0      // Pin 0, Auxiliary discrete input 1
@@ -42,7 +53,7 @@
 //SERIAL DEBUG - Reserved
 //RX3 PIN 7             // Pin 7
 //TX3 PIN 8             // Pin 8
-#define HWSERIAL Serial3
+#define HWSERIAL Serial3   //Text debug output, also carries the binary parameter protocol (see paramRegistry.h)
 
 //ANALOG INPUT PINS
 #define AN1PIN 0        // Pin 14, Wheel (turning) 
@@ -66,9 +77,34 @@
 
 ht1621_LCD lcd;
 
-#define ANALOG_RES 13     // Resolution of the analog reads (bits)
+#define ANALOG_RES 13     // Resolution of the analog reads (bits). Each channel converts at the
+                          //   resolution in its adc_profiles entry and is normalized to this.
+
+//Per channel ADC configuration, indexed by analog channel (AN1PIN - AN7PIN).
+//  Run the ADC benchmark (hold BENCH_BUTTON at power on) to pick these from data.
+//  {resolution, hardware averaging, conversion speed, sampling speed, software samples (>= 1)}
+#define NUM_ADC_CHANNELS 7
+#define ADC_DEFAULT_PROFILE {16, 4, ADC_SPEED_MED, ADC_SPEED_MED, 5}
+ADC_PROFILE_T adc_profiles[NUM_ADC_CHANNELS] = {
+  ADC_DEFAULT_PROFILE, // AN1PIN, Wheel
+  ADC_DEFAULT_PROFILE, // AN2PIN, Trigger
+  ADC_DEFAULT_PROFILE, // AN3PIN, Buttons
+  ADC_DEFAULT_PROFILE, // AN4PIN, Aux. analog input 1
+  ADC_DEFAULT_PROFILE, // AN5PIN, Aux. analog input 2
+  ADC_DEFAULT_PROFILE, // AN6PIN, Aux. analog input 3
+  ADC_DEFAULT_PROFILE  // AN7PIN, Aux. analog input 4
+};
+
+ADC* adc = new ADC();
+teensyAdcSource adc_source;
 
-#define BUTTON_TOL 300   // Allowable error in bits (Assuming 13bit precision ADC) from the measured button voltages.
+//ADC BENCHMARK
+//  Settings swept are ADC_DEFAULT_SWEEP (adcBench.cpp), the same sweep host/adc_sweep runs.
+const uint8_t bench_channels[] = {AN1PIN, AN2PIN, AN3PIN};
+adcBench adc_bench;
+adcSynth adc_synth;
+
+#define BUTTON_TOL 300   // Default allowable error in bits (Assuming 13bit precision ADC) from the measured button voltages.
                          // Worst case emperical separation between voltages was about 700 bits.
                          // Tolerance should be less than half worst case separation. Will be used for +/- tol about setpoints.
 #define BTN_NONE_PRESSED       0x1FFC  // 3.32V (0x1FFC) - No buttons pressed
@@ -92,6 +128,7 @@ enum BUTTON_T {
 BUTTON_T button_pressed = NONE;
 #define CAL_BUTTON RIGHT_MENU      //Button to press to enter/exit the calibration menu
 #define CAL_EXIT_BUTTON LEFT_MENU  //Button to hold to exit cal without saving changes
+#define BENCH_BUTTON LEFT_TUNE     //Button to hold at power on to run the ADC benchmark
 
 enum analog_indicator {
   wheel_ind,        //horizontal bar (numeric and gauge)
@@ -151,11 +188,95 @@ struct CAL_DATA_T {
 
 boolean cal_valid = false;
 
-#define MILLIDEBOUNCE 20  //Button debounce time in milliseconds
-Bounce aux1 = Bounce(AUX1_PIN, MILLIDEBOUNCE);
-Bounce aux2 = Bounce(AUX2_PIN, MILLIDEBOUNCE);
-Bounce aux3 = Bounce(AUX3_PIN, MILLIDEBOUNCE);
-Bounce aux4 = Bounce(AUX4_PIN, MILLIDEBOUNCE);
+#define MILLIDEBOUNCE 20           //Default button debounce (lockout) time in milliseconds
+#define DEBOUNCE_SAMPLE_US 1000    //Period of the discrete input sampler
+#define DEBOUNCE_LEADING_EDGE true //Default, true = report a press on its first edge, then lock out bounce
+                                   //false = report once the input has been stable for MILLIDEBOUNCE
+
+//Discrete inputs, also the bit position of each input in the debouncer sample word.
+//  To add a discrete input, add it here and to read_discretes().
+enum EVENT_SOURCE_T {
+  AUX1_EVT,
+  AUX2_EVT,
+  AUX3_EVT,
+  AUX4_EVT,
+  NUM_EVT_SOURCES
+};
+
+//The sampler ISR debounces all discrete inputs in parallel and pushes each debounced edge
+//  here, loop() drains it before building the report.
+IntervalTimer discrete_sampler;
+vDebounce discrete_debounce;
+eventQueue input_events;
+boolean aux_down[NUM_EVT_SOURCES] = {false, false, false, false};   //Debounced state as of the last event
+boolean aux_tapped[NUM_EVT_SOURCES] = {false, false, false, false}; //Press seen since the last report
+uint32_t last_overflows = 0;
+
+//RUNTIME PARAMETERS
+//  Tunable over HWSERIAL without reflashing. The defines are the defaults used until a set
+//  of parameters has been persisted to EEPROM.
+#define IIR_ALPHA 0.70       //Display filter weight on the previous value
+#define LOOP_PERIOD_MS 35    //Delay at the end of each loop iteration
+#define STICK_OUT_MIN -32768 //XInput stick range
+#define STICK_OUT_MAX 32767
+#define TRIGGER_OUT_MIN 0    //XInput trigger range
+#define TRIGGER_OUT_MAX 0xFF
+
+struct PARAMS_T {
+  float iir_alpha;
+  int32_t button_tol;
+  int32_t debounce_ms;
+  int32_t debounce_leading; //1 = leading edge, 0 = integrating
+  int32_t loop_period_ms;
+  int32_t stick_out_min;
+  int32_t stick_out_max;
+  int32_t trigger_out_min;
+  int32_t trigger_out_max;
+};
+
+//Parameters used by the code. Only changed by param_registry.apply() at the top of loop().
+PARAMS_T params = {IIR_ALPHA, BUTTON_TOL, MILLIDEBOUNCE, DEBOUNCE_LEADING_EDGE, LOOP_PERIOD_MS,
+                   STICK_OUT_MIN, STICK_OUT_MAX, TRIGGER_OUT_MIN, TRIGGER_OUT_MAX};
+PARAMS_T params_staged = params; //Received changes waiting to be applied
+
+//Parameter id is the index in this table. Append new parameters to keep ids stable.
+const PARAM_DESC_T param_descs[] = {
+  {"iir_alpha",       PARAM_FLOAT, offsetof(PARAMS_T, iir_alpha),        0.0,    0.99},
+  {"button_tol",      PARAM_INT32, offsetof(PARAMS_T, button_tol),       0,      4096},
+  {"debounce_ms",     PARAM_INT32, offsetof(PARAMS_T, debounce_ms),      1,
+      VDEBOUNCE_MAX_SAMPLES * DEBOUNCE_SAMPLE_US / 1000},
+  {"debounce_lead",   PARAM_INT32, offsetof(PARAMS_T, debounce_leading), 0,      1},
+  {"loop_period_ms",  PARAM_INT32, offsetof(PARAMS_T, loop_period_ms),   0,      1000},
+  {"stick_out_min",   PARAM_INT32, offsetof(PARAMS_T, stick_out_min),    -32768, 0},
+  {"stick_out_max",   PARAM_INT32, offsetof(PARAMS_T, stick_out_max),    0,      32767},
+  {"trigger_out_min", PARAM_INT32, offsetof(PARAMS_T, trigger_out_min),  0,      0xFF},
+  {"trigger_out_max", PARAM_INT32, offsetof(PARAMS_T, trigger_out_max),  0,      0xFF}
+};
+#define NUM_PARAMS (sizeof(param_descs) / sizeof(param_descs[0]))
+
+//Read-only values reported over the same protocol, ids follow the parameters.
+struct STATUS_T {
+  int32_t event_overflows; //Input events dropped because the queue was full
+  int32_t event_peak;      //Deepest the input event queue has been
+};
+
+STATUS_T status_values = {0, 0};
+
+const PARAM_DESC_T status_descs[] = {
+  {"evt_overflows",   PARAM_INT32, offsetof(STATUS_T, event_overflows),  0,      2147483647.0},
+  {"evt_peak",        PARAM_INT32, offsetof(STATUS_T, event_peak),       0,      EVENT_QUEUE_LEN}
+};
+#define NUM_STATUS (sizeof(status_descs) / sizeof(status_descs[0]))
+
+paramRegistry param_registry;
+
+//Persisted parameters are stored in EEPROM right after the calibration data.
+#define PARAM_EEPROM_ADDR sizeof(CAL_DATA_T)
+struct PARAM_STORE_T {
+  long layout;    //param_registry.layout() when stored, rejects records from a different layout
+  PARAMS_T params;
+  long cksum;     //XOR of previous fields (as 32 bit words)
+};
 
 int wheelValue = 0;
 int triggerValue = 0;
@@ -218,8 +339,14 @@ void setup() {
   HWSERIAL.println("");
   HWSERIAL.println("FRC2168 - XINPUT Controller - github.com/jcorcoran/jjrc_xinput_controller");
 
-  //Increase resolution of analog inputs.
-  analogReadResolution(ANALOG_RES);
+  //Load tunable parameters from EEPROM (defaults if none stored)
+  param_registry.setup(param_descs, NUM_PARAMS, &params, &params_staged, sizeof(PARAMS_T),
+    param_write, store_params);
+  param_registry.setupStatus(status_descs, NUM_STATUS, &status_values);
+  read_params();
+
+  //Analog inputs are configured per channel from adc_profiles.
+  adc_source.setup(adc);
 
   lcd.setup(LCD_CSPIN, LCD_WRPIN, LCD_DATAPIN);
   lcd.conf();
@@ -250,7 +377,27 @@ void setup() {
     calibrate(); //Enter Calibration Mode
   }
 
+  b = read_buttons();
+  //Must continue to hold button for 5s
+  for(int i=0; i<1000 && b == BENCH_BUTTON; i++){
+    b = read_buttons();
+    delay(5);
+  }
+  if(b == BENCH_BUTTON) {
+    adc_benchmark(); //Sweep ADC settings and report
+  }
+
   LCDSegsOff();
+
+  //Start sampling discrete inputs only now that loop() is about to drain the queue.
+  //  Started before calibration or the benchmark, it would fill up and drop releases.
+  discrete_debounce.setup(read_discretes(), params.debounce_ms * 1000UL / DEBOUNCE_SAMPLE_US,
+    params.debounce_leading);
+  //The debouncer only reports changes, so seed inputs already held at this point.
+  for(int i=0; i < NUM_EVT_SOURCES; i++) {
+    aux_down[i] = !((discrete_debounce.read() >> i) & 1);
+  }
+  discrete_sampler.begin(sample_discretes, DEBOUNCE_SAMPLE_US);
   
   //Load in CAL data from EEPROM
   cal_valid = read_cal();
@@ -263,11 +410,13 @@ void setup() {
 void loop() {
   int abs_throttle = 0;
 
+  //Pick up any parameter changes received during the last iteration
+  if(param_registry.apply()) {
+    apply_params();
+  }
+
   //Read pin values
-  aux1.update();
-  aux2.update();
-  aux3.update();
-  aux4.update();
+  process_events();
   wheelValue = avgAnalogRead(AN1PIN);
   triggerValue = avgAnalogRead(AN2PIN);
 
@@ -285,10 +434,14 @@ void loop() {
   controller.buttonUpdate(BUTTON_Y, button_pressed == BACK_TUNE);
   controller.buttonUpdate(BUTTON_BACK, button_pressed == LEFT_MENU);
   controller.buttonUpdate(BUTTON_START, button_pressed == RIGHT_MENU);
-  controller.buttonUpdate(BUTTON_LB, !aux1.read());
-  controller.buttonUpdate(BUTTON_RB, !aux2.read());
-  controller.buttonUpdate(BUTTON_L3, !aux3.read());
-  controller.buttonUpdate(BUTTON_R3, !aux4.read());
+  //A tap that started and ended between two loop iterations is still reported for one frame.
+  controller.buttonUpdate(BUTTON_LB, aux_down[AUX1_EVT] || aux_tapped[AUX1_EVT]);
+  controller.buttonUpdate(BUTTON_RB, aux_down[AUX2_EVT] || aux_tapped[AUX2_EVT]);
+  controller.buttonUpdate(BUTTON_L3, aux_down[AUX3_EVT] || aux_tapped[AUX3_EVT]);
+  controller.buttonUpdate(BUTTON_R3, aux_down[AUX4_EVT] || aux_tapped[AUX4_EVT]);
+  for(int i=0; i < NUM_EVT_SOURCES; i++) {
+    aux_tapped[i] = false;
+  }
 
   //Update analog sticks
   if(!LEFT_STICK_DISABLED) {
@@ -334,7 +487,13 @@ void loop() {
 
   //Dump LCD data out to the screen
   lcd.update();
-  delay(35);
+
+  //Handle parameter requests, changes are staged until the next iteration
+  while(HWSERIAL.available()) {
+    param_registry.receive(HWSERIAL.read());
+  }
+
+  delay(params.loop_period_ms);
 }
 
 void LCDSegsOff() {
@@ -421,8 +580,88 @@ void updateGauge(analog_indicator gaugeID, int val, int min, int max) {
   }
 }
 
+/**
+ * Sample all discrete inputs into one word, one bit per EVENT_SOURCE_T.
+ * AUX1-4 sit on three different GPIO ports (B, D, A) so they can't come from a single
+ * port read; with constant pin numbers each digitalReadFast is a single register load.
+ */
+uint32_t read_discretes() {
+  return ((uint32_t)digitalReadFast(AUX1_PIN) << AUX1_EVT)
+       | ((uint32_t)digitalReadFast(AUX2_PIN) << AUX2_EVT)
+       | ((uint32_t)digitalReadFast(AUX3_PIN) << AUX3_EVT)
+       | ((uint32_t)digitalReadFast(AUX4_PIN) << AUX4_EVT);
+}
+
+/**
+ * Discrete input sampler ISR, runs every DEBOUNCE_SAMPLE_US.
+ * Debounces every input at once and timestamps each debounced edge for the main loop.
+ * This is the only producer for input_events.
+ */
+void sample_discretes() {
+  uint32_t changed = discrete_debounce.update(read_discretes());
+  uint32_t levels;
+  uint32_t now;
+
+  if(changed) {
+    levels = discrete_debounce.read();
+    now = micros();
+    for(int i=0; i < NUM_EVT_SOURCES; i++) {
+      if(changed & (1UL << i)) {
+        input_events.push(now, i, (levels >> i) & 1);
+      }
+    }
+  }
+}
+
+/**
+ * Drain the input event queue in order.
+ * Events are already debounced. Inputs are active low.
+ * If events were dropped the held state is resynced from the debouncer.
+ */
+void process_events() {
+  INPUT_EVENT_T e;
+  uint32_t overflows;
+
+  while(input_events.pop(&e)) {
+    if(e.source >= NUM_EVT_SOURCES) {
+      continue;
+    }
+
+    aux_down[e.source] = (e.level == LOW);
+    if(aux_down[e.source]) {
+      aux_tapped[e.source] = true;
+    }
+
+    if(EVENT_TELEMETRY && !param_registry.active()) {
+      HWSERIAL.print("EVT ");
+      HWSERIAL.print(e.timestamp);
+      HWSERIAL.print(" AUX");
+      HWSERIAL.print(e.source + 1);
+      HWSERIAL.println(e.level == LOW ? " down" : " up");
+    }
+  }
+
+  overflows = input_events.overflows();
+  status_values.event_overflows = overflows;
+  status_values.event_peak = input_events.peak();
+  if(overflows != last_overflows) {
+    //Dropped edges can leave aux_down stale. Taps already seen are kept.
+    for(int i=0; i < NUM_EVT_SOURCES; i++) {
+      aux_down[i] = !((discrete_debounce.read() >> i) & 1);
+    }
+
+    if(!param_registry.active()) {
+      HWSERIAL.print("Input event queue overflow, dropped: ");
+      HWSERIAL.print(overflows);
+      HWSERIAL.print(" peak depth: ");
+      HWSERIAL.println(input_events.peak());
+    }
+    last_overflows = overflows;
+  }
+}
+
 float iir(float old_val, float new_val) {
-  float a = 0.70;
+  float a = params.iir_alpha;
   return ((old_val * a) + (new_val * (1.0 - a)));
 }
 
@@ -452,24 +691,24 @@ BUTTON_T read_buttons() {
   BUTTON_T retval = NONE;
 
   //Walk down the voltages to see if anything was pressed.
-  if(value >= (BTN_NONE_PRESSED - BUTTON_TOL)) {
+  if(value >= (BTN_NONE_PRESSED - params.button_tol)) {
     retval = NONE;
-  } else if(value <= (BTN_RIGHT_MENU_PRESSED + BUTTON_TOL)
-      && value >= (BTN_RIGHT_MENU_PRESSED - BUTTON_TOL)) {
+  } else if(value <= (BTN_RIGHT_MENU_PRESSED + params.button_tol)
+      && value >= (BTN_RIGHT_MENU_PRESSED - params.button_tol)) {
     retval = RIGHT_MENU;
-  } else if(value <= (BTN_LEFT_MENU_PRESSED + BUTTON_TOL)
-      && value >= (BTN_LEFT_MENU_PRESSED - BUTTON_TOL)) {
+  } else if(value <= (BTN_LEFT_MENU_PRESSED + params.button_tol)
+      && value >= (BTN_LEFT_MENU_PRESSED - params.button_tol)) {
     retval = LEFT_MENU;
-  } else if(value <= (BTN_FWD_TUNE_PRESSED + BUTTON_TOL)
-      && value >= (BTN_FWD_TUNE_PRESSED - BUTTON_TOL)) {
+  } else if(value <= (BTN_FWD_TUNE_PRESSED + params.button_tol)
+      && value >= (BTN_FWD_TUNE_PRESSED - params.button_tol)) {
     retval = FWD_TUNE;
-  } else if(value <= (BTN_LEFT_TUNE_PRESSED + BUTTON_TOL)
-      && value >= (BTN_LEFT_TUNE_PRESSED - BUTTON_TOL)) {
+  } else if(value <= (BTN_LEFT_TUNE_PRESSED + params.button_tol)
+      && value >= (BTN_LEFT_TUNE_PRESSED - params.button_tol)) {
     retval = LEFT_TUNE;
-  } else if(value <= (BTN_RIGHT_TUNE_PRESSED + BUTTON_TOL)
-      && value >= (BTN_RIGHT_TUNE_PRESSED - BUTTON_TOL)) {
+  } else if(value <= (BTN_RIGHT_TUNE_PRESSED + params.button_tol)
+      && value >= (BTN_RIGHT_TUNE_PRESSED - params.button_tol)) {
     retval = RIGHT_TUNE;
-  } else if(value <= (BTN_BACK_TUNE_PRESSED + BUTTON_TOL)) {
+  } else if(value <= (BTN_BACK_TUNE_PRESSED + params.button_tol)) {
     retval = BACK_TUNE;
   }
   
@@ -564,6 +803,53 @@ void calibrate() {
   }
 }
 
+/**
+ * Sweep ADC settings on each of the bench_channels and print a table of
+ * conversion time, noise at rest and step response lag for every combination.
+ * Inputs must be left at rest while it runs.
+ */
+void adc_benchmark() {
+  BUTTON_T b = BENCH_BUTTON;
+  uint8_t c;
+
+  HWSERIAL.println("Entering ADC Benchmark Mode");
+
+  y_segs.DisplayString("Ad");
+  x_segs.DisplayString("");
+  volt_segs.DisplayString("");
+  lcd.update();
+
+  //Wait until the benchmark button is released so it doesn't disturb the button channel.
+  while(b == BENCH_BUTTON){
+    b = read_buttons();
+    delay(10);
+  }
+
+  if(ADC_BENCH_SYNTHETIC) {
+    HWSERIAL.println("Source: synthetic noise model");
+    adc_bench.setup(&adc_synth);
+  } else {
+    HWSERIAL.println("Source: ADC0, leave all inputs at rest");
+    adc_bench.setup(&adc_source);
+  }
+
+  for(unsigned int ch=0; ch < sizeof(bench_channels); ch++) {
+    c = bench_channels[ch];
+    x_segs.DisplayInt(c);
+    lcd.update();
+
+    HWSERIAL.print("Channel ");
+    HWSERIAL.println(c);
+    adc_bench.sweep(c, adc_profiles[c], ADC_DEFAULT_SWEEP, print_bench_line);
+  }
+
+  HWSERIAL.println("ADC Benchmark finished.");
+}
+
+void print_bench_line(const char* line) {
+  HWSERIAL.println(line);
+}
+
 /**
  * Reads the stored calibration data from EEPROM
  * Returns true if data is valid, false otherwise.
@@ -611,13 +897,83 @@ void print_cal(CAL_DATA_T cal) {
   HWSERIAL.println(cal.cksum, HEX);
 }
 
+/**
+ * Push newly applied parameters into anything that keeps its own copy.
+ * The sampler ISR picks these up on its next tick; a mode or length change
+ * mid-press can stretch that press's lockout, but never drops an edge.
+ */
+void apply_params() {
+  //Keep the sampler ISR from running with the new length and the old mode (or vice versa).
+  noInterrupts();
+  discrete_debounce.setSamples(params.debounce_ms * 1000UL / DEBOUNCE_SAMPLE_US);
+  discrete_debounce.setLeadingEdge(params.debounce_leading);
+  interrupts();
+}
+
+/**
+ * Sends parameter protocol responses to the host.
+ */
+void param_write(const uint8_t* buf, uint8_t len) {
+  HWSERIAL.write(buf, len);
+}
+
+long params_cksum(PARAM_STORE_T store) {
+  long words[(sizeof(long) + sizeof(PARAMS_T)) / sizeof(long)];
+  long cksum = 0;
+
+  memcpy(words, &store, sizeof(words));
+  for(unsigned int i=0; i < sizeof(words) / sizeof(long); i++) {
+    cksum ^= words[i];
+  }
+  return cksum;
+}
+
+/**
+ * Reads the stored parameters from EEPROM into params.
+ * The record must match the current parameter layout and checksum, and every value
+ * must pass the registry's range checks. Otherwise the defaults are kept.
+ * Returns true if data is valid, false otherwise.
+ */
+boolean read_params() {
+  PARAM_STORE_T store;
+  boolean retval = false;
+
+  eeprom_read_block((void*)&store, (void*)PARAM_EEPROM_ADDR, sizeof(store));
+
+  if(store.layout == (long)param_registry.layout()
+      && store.cksum == params_cksum(store)
+      && param_registry.stage(&store.params) == PARAM_OK) {
+    param_registry.apply();
+    HWSERIAL.println("Parameters loaded.");
+    retval = true;
+  } else {
+    HWSERIAL.println("No valid stored parameters, using defaults.");
+  }
+
+  return retval;
+}
+
+/**
+ * Writes the staged parameters to EEPROM. Called by the registry on a persist request.
+ */
+bool store_params() {
+  PARAM_STORE_T store;
+
+  store.layout = param_registry.layout();
+  store.params = params_staged;
+  store.cksum = params_cksum(store);
+
+  eeprom_update_block((void*)&store, (void*)PARAM_EEPROM_ADDR, sizeof(store));
+  return true;
+}
+
 /**
  * Scale the analog inputs to the range used by joystick function.
  *
  */
 int xinput_scale_sticks(int val) {
-  int _out_max = 32767;
-  int _out_min = -32768;
+  int _out_max = params.stick_out_max;
+  int _out_min = params.stick_out_min;
   int _in_min = 0;
   int _in_max = pow(2,ANALOG_RES);
   int _in_zero = (_in_max - _in_min)/2;
@@ -640,8 +996,8 @@ int xinput_scale_sticks(int val) {
  *   right trigger is the high side of the range (1.5 - 3V)
  */
 int xinput_scale_trigger(int val) {
-  int _out_max = 0xFF;
-  int _out_min = 0;
+  int _out_max = params.trigger_out_max;
+  int _out_min = params.trigger_out_min;
   int _in_min = 0;
   int _in_max = pow(2,ANALOG_RES);
   int _in_zero = (_in_max - _in_min)/2;
@@ -699,13 +1055,26 @@ int cal_scale_axis(analog_axis axis, int val) {
   return ret;
 }
 
+/**
+ * Take a software averaged reading using the channel's ADC profile.
+ * The result is normalized to ANALOG_RES bits whatever resolution the channel converts at.
+ */
 int avgAnalogRead(int channel) {
-  #define SAMPLES 5
+  ADC_PROFILE_T p = adc_profiles[channel];
+  int n = p.sw_samples < 1 ? 1 : p.sw_samples;
   int average = 0;
 
-  for(int i=0; i < SAMPLES; i++) {
-    average += analogRead(channel);
+  adc_source.apply(channel, p);
+  for(int i=0; i < n; i++) {
+    average += adc_source.read(channel);
+  }
+  average = average / n;
+
+  if(p.resolution > ANALOG_RES) {
+    average >>= (p.resolution - ANALOG_RES);
+  } else {
+    average <<= (ANALOG_RES - p.resolution);
   }
 
-  return average / SAMPLES;
+  return average;
 }
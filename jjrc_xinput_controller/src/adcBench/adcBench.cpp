@@ -0,0 +1,301 @@
+// ADC configuration benchmark.
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "adcBench.h"
+
+#define ADC_BENCH_STEP_READS 12   //Readings taken after a step while looking for 90% settling
+#define ADC_BENCH_STEP_OFFSET 0.11 //Step lands this fraction of a reading after it starts (boxcar worst case)
+
+//Synthetic model of a Kinetis style SAR ADC. Rough numbers, only the trends matter:
+//  faster conversion/sampling costs less time but lets more noise through.
+const float SYNTH_CONV_US[ADC_SPEED_COUNT]    = {20.0, 12.0, 6.0, 3.5, 2.2}; //Per 16 bit conversion
+const float SYNTH_SAMP_US[ADC_SPEED_COUNT]    = {8.0, 4.0, 2.0, 1.0, 0.5};   //Added sample time
+const float SYNTH_CONV_NOISE[ADC_SPEED_COUNT] = {1.0, 1.1, 1.3, 1.7, 2.4};   //Noise multiplier
+const float SYNTH_SAMP_NOISE[ADC_SPEED_COUNT] = {1.0, 1.05, 1.2, 1.5, 2.0};  //Noise multiplier
+
+const char* ADC_SPEED_NAMES[ADC_SPEED_COUNT] = {"ADC_SPEED_VERY_LOW", "ADC_SPEED_LOW",
+                                                "ADC_SPEED_MED", "ADC_SPEED_HIGH",
+                                                "ADC_SPEED_VERY_HIGH"};
+
+const uint8_t SWEEP_RESOLUTIONS[] = {8, 10, 12, 16};
+const uint8_t SWEEP_HW_AVERAGING[] = {1, 4, 8, 16, 32};
+const uint8_t SWEEP_SPEEDS[] = {ADC_SPEED_VERY_LOW, ADC_SPEED_LOW, ADC_SPEED_MED, ADC_SPEED_HIGH,
+                                ADC_SPEED_VERY_HIGH};
+const uint8_t SWEEP_SW_SAMPLES[] = {1, 2, 5, 8};
+
+const ADC_SWEEP_T ADC_DEFAULT_SWEEP = {
+  SWEEP_RESOLUTIONS, sizeof(SWEEP_RESOLUTIONS),
+  SWEEP_HW_AVERAGING, sizeof(SWEEP_HW_AVERAGING),
+  SWEEP_SPEEDS, sizeof(SWEEP_SPEEDS),
+  SWEEP_SW_SAMPLES, sizeof(SWEEP_SW_SAMPLES),
+  64,    //Rest samples
+  2000.0 //Lag budget (us)
+};
+
+adcSynth::adcSynth() {
+  setup(0.5, 0.75, 6.0);
+}
+
+/**
+ * rest_level - input at rest, 0.0 - 1.0 of full scale
+ * step_level - input after a step, 0.0 - 1.0 of full scale
+ * noise_lsb16 - input referred noise in 16 bit LSBs (1 sigma) at the slowest speeds
+ */
+void adcSynth::setup(float rest_level, float step_level, float noise_lsb16) {
+  _rest_level = rest_level;
+  _step_level = step_level;
+  _noise_lsb16 = noise_lsb16;
+  _clock_us = 0;
+  _step_at_us = INFINITY;
+  _seed = 2168;
+}
+
+/**
+ * Applying a profile also puts the input back at rest and restarts the simulated clock.
+ */
+void adcSynth::apply(uint8_t /*channel*/, const ADC_PROFILE_T& p) {
+  _profile = p;
+  _clock_us = 0;
+  _step_at_us = INFINITY;
+}
+
+float adcSynth::conversionTime() {
+  float t = SYNTH_CONV_US[_profile.conv_speed] + SYNTH_SAMP_US[_profile.samp_speed];
+
+  if(_profile.resolution < 16) {
+    t *= 0.8; //Fewer ADC clocks per conversion below 16 bits
+  }
+  return t;
+}
+
+/**
+ * Standard normal random number (xorshift + Box-Muller), repeatable between runs.
+ */
+float adcSynth::gaussian() {
+  float u1, u2;
+
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  u1 = (_seed + 1.0) / 4294967296.0;
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  u2 = _seed / 4294967296.0;
+
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+int adcSynth::read(uint8_t /*channel*/) {
+  int hw = _profile.hw_averaging < 1 ? 1 : _profile.hw_averaging;
+  float sigma = _noise_lsb16 * SYNTH_CONV_NOISE[_profile.conv_speed]
+      * SYNTH_SAMP_NOISE[_profile.samp_speed];
+  float t_conv = conversionTime();
+  float full_scale = pow(2, _profile.resolution);
+  float acc = 0;
+  int ret;
+
+  for(int i=0; i < hw; i++) {
+    _clock_us += t_conv;
+    acc += (_clock_us >= _step_at_us ? _step_level : _rest_level) * 65536.0 + sigma * gaussian();
+  }
+
+  ret = floor((acc / hw) / 65536.0 * full_scale);
+  if(ret < 0) {
+    ret = 0;
+  } else if(ret > full_scale - 1) {
+    ret = full_scale - 1;
+  }
+  return ret;
+}
+
+uint32_t adcSynth::now_us() {
+  return _clock_us;
+}
+
+bool adcSynth::step(uint8_t /*channel*/, uint32_t at_us) {
+  _step_at_us = at_us;
+  return true;
+}
+
+adcBench::adcBench() {
+  _source = 0;
+}
+
+void adcBench::setup(adcSource* source) {
+  _source = source;
+}
+
+/**
+ * One software averaged reading, the same way the main loop takes them.
+ */
+int adcBench::reading(uint8_t channel, const ADC_PROFILE_T& p) {
+  int n = p.sw_samples < 1 ? 1 : p.sw_samples;
+  long sum = 0;
+
+  for(int i=0; i < n; i++) {
+    sum += _source->read(channel);
+  }
+  return sum / n;
+}
+
+/**
+ * Apply profile p to the channel and measure it.
+ * The input must be at rest (not moving) for rest_samples readings.
+ */
+ADC_BENCH_RESULT_T adcBench::measure(uint8_t channel, const ADC_PROFILE_T& p, int rest_samples) {
+  ADC_BENCH_RESULT_T r;
+  uint32_t start;
+  uint32_t step_at;
+  uint32_t done_at[ADC_BENCH_STEP_READS];
+  int vals[ADC_BENCH_STEP_READS];
+  float mean = 0;
+  float m2 = 0;
+  float delta;
+  float threshold;
+  int v;
+
+  _source->apply(channel, p);
+  reading(channel, p); //Let the input settle on the new configuration
+
+  //Noise at rest (Welford's running variance)
+  start = _source->now_us();
+  for(int i=1; i <= rest_samples; i++) {
+    v = reading(channel, p);
+    delta = v - mean;
+    mean += delta / i;
+    m2 += delta * (v - mean);
+  }
+  r.read_us = (float)(_source->now_us() - start) / rest_samples;
+  r.mean = mean;
+  r.stddev = rest_samples > 1 ? sqrt(m2 / (rest_samples - 1)) : 0;
+
+  //An ideal quantizer alone has 1/sqrt(12) LSB of noise.
+  if(r.stddev * sqrt(12.0) > 1.0) {
+    r.enob = p.resolution - log(r.stddev * sqrt(12.0)) / log(2.0);
+  } else {
+    r.enob = p.resolution;
+  }
+
+  //Step response
+  step_at = _source->now_us() + r.read_us * ADC_BENCH_STEP_OFFSET;
+  r.lag_measured = _source->step(channel, step_at);
+  r.lag_us = 2 * r.read_us;
+  if(r.lag_measured) {
+    for(int i=0; i < ADC_BENCH_STEP_READS; i++) {
+      vals[i] = reading(channel, p);
+      done_at[i] = _source->now_us();
+    }
+
+    //Last reading is taken as fully settled.
+    threshold = mean + 0.9 * (vals[ADC_BENCH_STEP_READS - 1] - mean);
+    for(int i=0; i < ADC_BENCH_STEP_READS; i++) {
+      if((threshold >= mean && vals[i] >= threshold) || (threshold < mean && vals[i] <= threshold)) {
+        r.lag_us = done_at[i] - step_at;
+        break;
+      }
+    }
+  }
+
+  return r;
+}
+
+/**
+ * Print v with a fixed number of decimals, like snprintf returns the length printed.
+ * Done with integers so it doesn't depend on printf float support, which isn't
+ * linked in on every Teensy. Values that round to zero print without a sign.
+ */
+int adcBench::formatFixed(char* buf, int len, float v, int decimals) {
+  long scale = 1;
+  long x;
+  const char* sign;
+
+  for(int i=0; i < decimals; i++) {
+    scale *= 10;
+  }
+  x = (long)(fabs(v) * scale + 0.5);
+  sign = (v < 0 && x != 0) ? "-" : "";
+
+  if(decimals == 0) {
+    return snprintf(buf, len, "%s%ld", sign, x);
+  }
+  return snprintf(buf, len, "%s%ld.%0*ld", sign, x / scale, decimals, x % scale);
+}
+
+/**
+ * Profile as an adc_profiles initializer, e.g. {16, 4, ADC_SPEED_MED, ADC_SPEED_MED, 5}
+ */
+void adcBench::formatProfile(char* buf, int len, const ADC_PROFILE_T& p) {
+  snprintf(buf, len, "{%u, %u, %s, %s, %u}", p.resolution, p.hw_averaging,
+      ADC_SPEED_NAMES[p.conv_speed], ADC_SPEED_NAMES[p.samp_speed], p.sw_samples);
+}
+
+/**
+ * Measure every combination of settings in s on the channel. Prints a header, one
+ * tab separated row per combination and the suggested profile through print_line.
+ * Returns the profile with the best ENOB whose lag is within s.lag_budget_us, or
+ * current (the channel's profile in use) if none is.
+ */
+ADC_PROFILE_T adcBench::sweep(uint8_t channel, const ADC_PROFILE_T& current,
+    const ADC_SWEEP_T& s, void (*print_line)(const char* line)) {
+  char line[ADC_BENCH_LINE_LEN];
+  char profile[64];
+  ADC_PROFILE_T p;
+  ADC_PROFILE_T best = current;
+  ADC_BENCH_RESULT_T r;
+  float best_enob = 0;
+  bool found = false;
+  int n;
+
+  print_line("res\thw_avg\tconv\tsamp\tsw\tread_us\tstddev\tenob\tlag_us");
+
+  for(int i=0; i < s.n_resolutions; i++) {
+    for(int j=0; j < s.n_hw_averaging; j++) {
+      for(int k=0; k < s.n_speeds; k++) {
+        for(int l=0; l < s.n_speeds; l++) {
+          for(int m=0; m < s.n_sw_samples; m++) {
+            p.resolution = s.resolutions[i];
+            p.hw_averaging = s.hw_averaging[j];
+            p.conv_speed = s.speeds[k];
+            p.samp_speed = s.speeds[l];
+            p.sw_samples = s.sw_samples[m];
+            r = measure(channel, p, s.rest_samples);
+
+            n = snprintf(line, sizeof(line), "%u\t%u\t%s\t%s\t%u\t", p.resolution,
+                p.hw_averaging, ADC_SPEED_NAMES[p.conv_speed], ADC_SPEED_NAMES[p.samp_speed],
+                p.sw_samples);
+            n += formatFixed(line + n, sizeof(line) - n, r.read_us, 1);
+            n += snprintf(line + n, sizeof(line) - n, "\t");
+            n += formatFixed(line + n, sizeof(line) - n, r.stddev, 2);
+            n += snprintf(line + n, sizeof(line) - n, "\t");
+            n += formatFixed(line + n, sizeof(line) - n, r.enob, 2);
+            n += snprintf(line + n, sizeof(line) - n, "\t");
+            n += formatFixed(line + n, sizeof(line) - n, r.lag_us, 0);
+            snprintf(line + n, sizeof(line) - n, "%s", r.lag_measured ? "" : "*"); //* = worst case, not measured
+            print_line(line);
+
+            if(r.lag_us <= s.lag_budget_us && (!found || r.enob > best_enob)) {
+              best = p;
+              best_enob = r.enob;
+              found = true;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  formatProfile(profile, sizeof(profile), best);
+  if(!found) {
+    snprintf(line, sizeof(line), "No profile within lag budget, keeping: %s", profile);
+  } else {
+    n = snprintf(line, sizeof(line), "Best ENOB within lag budget (");
+    n += formatFixed(line + n, sizeof(line) - n, best_enob, 2);
+    snprintf(line + n, sizeof(line) - n, "): %s", profile);
+  }
+  print_line(line);
+
+  return best;
+}
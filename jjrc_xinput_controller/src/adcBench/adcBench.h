@@ -0,0 +1,114 @@
+// ADC configuration benchmark.
+//   Measures conversion cost, noise at rest (stddev / ENOB) and step response lag
+//   of an ADC profile (resolution, hardware averaging, conversion/sampling speed and
+//   software oversampling) against any adcSource.
+//
+// adcSynth is a synthetic noise model source so profiles can be compared without
+//   hardware. See teensyAdcSource for the hardware source. Neither adcBench nor
+//   adcSynth touch Arduino APIs.
+
+#ifndef adcBench_h
+#define adcBench_h
+
+#include <stdint.h>
+
+enum ADC_SPEED_T {
+  ADC_SPEED_VERY_LOW,
+  ADC_SPEED_LOW,
+  ADC_SPEED_MED,
+  ADC_SPEED_HIGH,
+  ADC_SPEED_VERY_HIGH,
+  ADC_SPEED_COUNT
+};
+
+struct ADC_PROFILE_T {
+  uint8_t resolution;   //Conversion resolution (bits)
+  uint8_t hw_averaging; //Conversions averaged in hardware per read (1 = off, 4, 8, 16, 32)
+  uint8_t conv_speed;   //ADC_SPEED_T
+  uint8_t samp_speed;   //ADC_SPEED_T
+  uint8_t sw_samples;   //Reads averaged in software per reading
+};
+
+extern const char* ADC_SPEED_NAMES[ADC_SPEED_COUNT];
+
+struct ADC_BENCH_RESULT_T {
+  float read_us;     //Time for one complete (software averaged) reading
+  float mean;        //Mean reading at rest (LSBs at the profile's resolution)
+  float stddev;      //Standard deviation at rest (LSBs at the profile's resolution)
+  float enob;        //Effective number of bits at rest
+  float lag_us;      //Time from an input step until a reading reaches 90% of the step
+  bool lag_measured; //false = source can't produce a step, lag_us is the boxcar worst case (2 readings)
+};
+
+//Settings to sweep. Every combination is measured, speeds apply to both conversion and sampling.
+struct ADC_SWEEP_T {
+  const uint8_t* resolutions;
+  uint8_t n_resolutions;
+  const uint8_t* hw_averaging;
+  uint8_t n_hw_averaging;
+  const uint8_t* speeds;
+  uint8_t n_speeds;
+  const uint8_t* sw_samples;
+  uint8_t n_sw_samples;
+  int rest_samples;     //Readings per setting used to measure noise at rest
+  float lag_budget_us;  //Slowest step response considered when suggesting a profile
+};
+
+extern const ADC_SWEEP_T ADC_DEFAULT_SWEEP;
+
+#define ADC_BENCH_LINE_LEN 128 //Longest line passed to a sweep's print function
+
+//Anything that can take a reading with a given profile applied.
+class adcSource {
+public:
+  virtual void apply(uint8_t channel, const ADC_PROFILE_T& p) = 0;
+  virtual int read(uint8_t channel) = 0; //One (hardware averaged) read with the applied profile
+  virtual uint32_t now_us() = 0;
+  //Schedule a step on the input at time at_us. Return false if the source can't do it.
+  virtual bool step(uint8_t /*channel*/, uint32_t /*at_us*/) { return false; }
+};
+
+class adcSynth : public adcSource {
+
+public:
+  adcSynth();
+
+  void setup(float rest_level, float step_level, float noise_lsb16);
+  void apply(uint8_t channel, const ADC_PROFILE_T& p);
+  int read(uint8_t channel);
+  uint32_t now_us();
+  bool step(uint8_t channel, uint32_t at_us);
+
+private:
+  float gaussian();
+  float conversionTime();
+
+  ADC_PROFILE_T _profile;
+  float _rest_level;  //Input at rest, 0.0 - 1.0 of full scale
+  float _step_level;  //Input after the step, 0.0 - 1.0 of full scale
+  float _noise_lsb16; //Input referred noise (16 bit LSBs) at the slowest speeds
+  float _clock_us;    //Simulated time
+  float _step_at_us;
+  uint32_t _seed;
+};
+
+class adcBench {
+
+public:
+  adcBench();
+
+  void setup(adcSource* source);
+  ADC_BENCH_RESULT_T measure(uint8_t channel, const ADC_PROFILE_T& p, int rest_samples);
+  int reading(uint8_t channel, const ADC_PROFILE_T& p);
+  ADC_PROFILE_T sweep(uint8_t channel, const ADC_PROFILE_T& current, const ADC_SWEEP_T& s,
+      void (*print_line)(const char* line));
+
+  static int formatFixed(char* buf, int len, float v, int decimals);
+
+private:
+  void formatProfile(char* buf, int len, const ADC_PROFILE_T& p);
+
+  adcSource* _source;
+};
+
+#endif
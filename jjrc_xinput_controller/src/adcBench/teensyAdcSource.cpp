@@ -0,0 +1,59 @@
+// adcSource for the Teensy's on-chip ADC (ADC_0).
+
+#include <Arduino.h>
+#include "teensyAdcSource.h"
+
+const ADC_CONVERSION_SPEED CONV_SPEEDS[ADC_SPEED_COUNT] = {
+  ADC_CONVERSION_SPEED::VERY_LOW_SPEED,
+  ADC_CONVERSION_SPEED::LOW_SPEED,
+  ADC_CONVERSION_SPEED::MED_SPEED,
+  ADC_CONVERSION_SPEED::HIGH_SPEED,
+  ADC_CONVERSION_SPEED::VERY_HIGH_SPEED
+};
+
+const ADC_SAMPLING_SPEED SAMP_SPEEDS[ADC_SPEED_COUNT] = {
+  ADC_SAMPLING_SPEED::VERY_LOW_SPEED,
+  ADC_SAMPLING_SPEED::LOW_SPEED,
+  ADC_SAMPLING_SPEED::MED_SPEED,
+  ADC_SAMPLING_SPEED::HIGH_SPEED,
+  ADC_SAMPLING_SPEED::VERY_HIGH_SPEED
+};
+
+teensyAdcSource::teensyAdcSource() {
+  _adc = 0;
+  _applied_valid = false;
+}
+
+void teensyAdcSource::setup(ADC* adc) {
+  _adc = adc;
+  _applied_valid = false;
+}
+
+/**
+ * Load a profile into the ADC. Register writes are skipped if it's already loaded,
+ * so channels that share a profile don't pay for reconfiguring on every read.
+ */
+void teensyAdcSource::apply(uint8_t /*channel*/, const ADC_PROFILE_T& p) {
+  if(_applied_valid
+      && _applied.resolution == p.resolution
+      && _applied.hw_averaging == p.hw_averaging
+      && _applied.conv_speed == p.conv_speed
+      && _applied.samp_speed == p.samp_speed) {
+    return;
+  }
+
+  _adc->adc0->setResolution(p.resolution);
+  _adc->adc0->setAveraging(p.hw_averaging > 1 ? p.hw_averaging : 0);
+  _adc->adc0->setConversionSpeed(CONV_SPEEDS[p.conv_speed]);
+  _adc->adc0->setSamplingSpeed(SAMP_SPEEDS[p.samp_speed]);
+  _applied = p;
+  _applied_valid = true;
+}
+
+int teensyAdcSource::read(uint8_t channel) {
+  return _adc->adc0->analogRead(channel);
+}
+
+uint32_t teensyAdcSource::now_us() {
+  return micros();
+}
@@ -0,0 +1,26 @@
+// adcSource for the Teensy's on-chip ADC (ADC_0), using the ADC library bundled with Teensyduino.
+//   Used both by the benchmark and by the main loop so per-channel profiles are applied in one place.
+
+#ifndef teensyAdcSource_h
+#define teensyAdcSource_h
+
+#include <ADC.h>
+#include "adcBench.h"
+
+class teensyAdcSource : public adcSource {
+
+public:
+  teensyAdcSource();
+
+  void setup(ADC* adc);
+  void apply(uint8_t channel, const ADC_PROFILE_T& p);
+  int read(uint8_t channel);
+  uint32_t now_us();
+
+private:
+  ADC* _adc;
+  ADC_PROFILE_T _applied; //Profile currently loaded into the ADC registers
+  bool _applied_valid;
+};
+
+#endif
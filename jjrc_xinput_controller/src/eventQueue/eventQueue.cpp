@@ -0,0 +1,82 @@
+// Single-producer/single-consumer lock-free ring buffer of timestamped input events.
+
+#include "eventQueue.h"
+
+#define EVENT_QUEUE_MASK (EVENT_QUEUE_LEN - 1)
+
+eventQueue::eventQueue() {
+  _head = 0;
+  _tail = 0;
+  _overflows = 0;
+  _peak = 0;
+}
+
+/**
+ * Add an event to the queue. Only call from the producer context.
+ * Returns false (and counts an overflow) if the queue is full.
+ */
+bool eventQueue::push(uint32_t timestamp, uint8_t source, uint8_t level) {
+  uint8_t head = _head;
+  uint8_t used = (uint8_t)(head - _tail);
+
+  if(used >= EVENT_QUEUE_LEN) {
+    _overflows = _overflows + 1;
+    return false;
+  }
+
+  INPUT_EVENT_T* e = &_events[head & EVENT_QUEUE_MASK];
+  e->timestamp = timestamp;
+  e->source = source;
+  e->level = level;
+
+  //Event contents must be visible before the consumer sees the new head.
+  __sync_synchronize();
+  _head = head + 1;
+
+  if(used + 1 > _peak) {
+    _peak = used + 1;
+  }
+  return true;
+}
+
+/**
+ * Remove the oldest event from the queue. Only call from the consumer context.
+ * Returns false if the queue is empty.
+ */
+bool eventQueue::pop(INPUT_EVENT_T* e) {
+  uint8_t tail = _tail;
+
+  if(tail == _head) {
+    return false;
+  }
+
+  //Don't read the slot until we've seen the producer's head update.
+  __sync_synchronize();
+  *e = _events[tail & EVENT_QUEUE_MASK];
+
+  //Slot must be fully read before the producer is allowed to reuse it.
+  __sync_synchronize();
+  _tail = tail + 1;
+  return true;
+}
+
+/**
+ * Number of events waiting to be consumed.
+ */
+uint8_t eventQueue::count() {
+  return (uint8_t)(_head - _tail);
+}
+
+/**
+ * Number of events dropped since startup because the queue was full.
+ */
+uint32_t eventQueue::overflows() {
+  return _overflows;
+}
+
+/**
+ * Highest number of events that have been waiting in the queue at once.
+ */
+uint8_t eventQueue::peak() {
+  return _peak;
+}
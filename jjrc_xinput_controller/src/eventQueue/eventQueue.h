@@ -0,0 +1,49 @@
+// Single-producer/single-consumer lock-free ring buffer of timestamped input events.
+//   The discrete input sampler ISR (sample_discretes() in the sketch) pushes each
+//   debounced edge, the main loop pops them in order.
+//
+// Only one context may call push() and only one context may call pop(). The sampler ISR
+//   is the only producer, the main loop the only consumer.
+//
+// When the ring is full push() drops the new event (the queued ones are kept) and counts
+//   it in overflows(). The consumer can't rebuild state from events after an overflow, so
+//   it should resync from the source when overflows() changes.
+//
+// Has no Arduino dependencies.
+
+#ifndef eventQueue_h
+#define eventQueue_h
+
+#include <stdint.h>
+
+#define EVENT_QUEUE_LEN 32 //Number of slots in the ring. Must be a power of two, <= 128.
+
+struct INPUT_EVENT_T {
+  uint32_t timestamp; //Time the edge was observed (micros)
+  uint8_t source;     //Which input changed
+  uint8_t level;      //Input level after the edge
+};
+
+class eventQueue {
+
+public:
+  eventQueue();
+
+  //Producer side (ISR)
+  bool push(uint32_t timestamp, uint8_t source, uint8_t level);
+
+  //Consumer side (main loop)
+  bool pop(INPUT_EVENT_T* e);
+  uint8_t count();
+  uint32_t overflows();
+  uint8_t peak();
+
+private:
+  INPUT_EVENT_T _events[EVENT_QUEUE_LEN];
+  volatile uint8_t _head;       //Next slot to write, only modified by the producer
+  volatile uint8_t _tail;       //Next slot to read, only modified by the consumer
+  volatile uint32_t _overflows; //Events dropped because the ring was full
+  volatile uint8_t _peak;       //Deepest the ring has been since startup
+};
+
+#endif
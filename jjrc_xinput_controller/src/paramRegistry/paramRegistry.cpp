@@ -0,0 +1,312 @@
+// Registry of runtime tunable parameters with a compact binary get/set/list/persist protocol.
+
+#include <string.h>
+#include "paramRegistry.h"
+
+paramRegistry::paramRegistry() {
+  _descs = 0;
+  _count = 0;
+  _status_descs = 0;
+  _status_count = 0;
+  _status = 0;
+  _live = 0;
+  _staged = 0;
+  _size = 0;
+  _dirty = false;
+  _active = false;
+  _write = 0;
+  _persist = 0;
+  _rx_state = RX_SYNC;
+}
+
+/**
+ * descs - table describing each parameter, a parameter's id is its index in the table
+ * live - struct the application reads parameters from
+ * staged - struct of the same type that SETs are written to, must start out equal to live
+ * write - sends response bytes back to the host
+ * persist - saves the staged struct to non-volatile storage, returns true on success
+ */
+void paramRegistry::setup(const PARAM_DESC_T* descs, uint8_t count, void* live, void* staged,
+    uint16_t size, void (*write)(const uint8_t* buf, uint8_t len), bool (*persist)()) {
+  _descs = descs;
+  _count = count;
+  _live = (uint8_t*)live;
+  _staged = (uint8_t*)staged;
+  _size = size;
+  _write = write;
+  _persist = persist;
+  _dirty = false;
+  _active = false;
+  _rx_state = RX_SYNC;
+}
+
+/**
+ * descs - table describing each status value, ids continue on from the parameters
+ * values - struct holding the status values, updated by the application
+ */
+void paramRegistry::setupStatus(const PARAM_DESC_T* descs, uint8_t count, const void* values) {
+  _status_descs = descs;
+  _status_count = count;
+  _status = (const uint8_t*)values;
+}
+
+/**
+ * Descriptor of a parameter or status value, 0 if there's no such id.
+ */
+const PARAM_DESC_T* paramRegistry::desc(uint8_t id) {
+  if(id < _count) {
+    return &_descs[id];
+  }
+  if(id - _count < _status_count) {
+    return &_status_descs[id - _count];
+  }
+  return 0;
+}
+
+/**
+ * Read the staged value of a parameter, or the current value of a status value,
+ * as its raw 4 bytes.
+ */
+uint8_t paramRegistry::get(uint8_t id, uint32_t* raw) {
+  if(id < _count) {
+    memcpy(raw, _staged + _descs[id].offset, sizeof(*raw));
+  } else if(id - _count < _status_count) {
+    memcpy(raw, _status + _status_descs[id - _count].offset, sizeof(*raw));
+  } else {
+    return PARAM_ERR_ID;
+  }
+  return PARAM_OK;
+}
+
+/**
+ * Stage a new value for a parameter. Takes effect on the next apply().
+ */
+uint8_t paramRegistry::set(uint8_t id, uint32_t raw) {
+  float v;
+  int32_t i;
+
+  if(id >= _count) {
+    return id - _count < _status_count ? PARAM_ERR_READ_ONLY : PARAM_ERR_ID;
+  }
+
+  if(_descs[id].type == PARAM_FLOAT) {
+    memcpy(&v, &raw, sizeof(v));
+    if(!(v >= _descs[id].min && v <= _descs[id].max)) { //Also rejects NaN
+      return PARAM_ERR_RANGE;
+    }
+  } else {
+    memcpy(&i, &raw, sizeof(i));
+    if(i < _descs[id].min || i > _descs[id].max) {
+      return PARAM_ERR_RANGE;
+    }
+  }
+
+  memcpy(_staged + _descs[id].offset, &raw, sizeof(raw));
+  _dirty = true;
+  return PARAM_OK;
+}
+
+/**
+ * Stage every parameter from a struct laid out like the live one (e.g. a stored copy),
+ * range checking each field as set() does. All or nothing: if any field is rejected the
+ * staged copy is reset to the live values and that field's status is returned.
+ */
+uint8_t paramRegistry::stage(const void* values) {
+  uint32_t raw;
+  uint8_t status;
+
+  for(uint8_t id=0; id < _count; id++) {
+    memcpy(&raw, (const uint8_t*)values + _descs[id].offset, sizeof(raw));
+    status = set(id, raw);
+    if(status != PARAM_OK) {
+      memcpy(_staged, _live, _size);
+      _dirty = false;
+      return status;
+    }
+  }
+  return PARAM_OK;
+}
+
+/**
+ * Copy any staged changes over the live parameters. Call once per loop iteration,
+ * before the parameters are used. Returns true if anything changed.
+ */
+bool paramRegistry::apply() {
+  if(!_dirty) {
+    return false;
+  }
+  memcpy(_live, _staged, _size);
+  _dirty = false;
+  return true;
+}
+
+/**
+ * Feed in one byte received from the host. Complete frames are handled immediately.
+ */
+void paramRegistry::receive(uint8_t b) {
+  switch(_rx_state) {
+    case RX_SYNC:
+      if(b == PARAM_REQ_SYNC) {
+        _rx_state = RX_CMD;
+      }
+      break;
+    case RX_CMD:
+      _rx_cmd = b;
+      _rx_cksum = b;
+      _rx_state = RX_LEN;
+      break;
+    case RX_LEN:
+      _rx_len = b;
+      _rx_pos = 0;
+      _rx_cksum ^= b;
+      if(_rx_len > PARAM_MAX_PAYLOAD) {
+        _rx_state = RX_SYNC; //Can't be a valid frame, resync
+      } else if(_rx_len == 0) {
+        _rx_state = RX_CKSUM;
+      } else {
+        _rx_state = RX_PAYLOAD;
+      }
+      break;
+    case RX_PAYLOAD:
+      _rx[_rx_pos++] = b;
+      _rx_cksum ^= b;
+      if(_rx_pos >= _rx_len) {
+        _rx_state = RX_CKSUM;
+      }
+      break;
+    case RX_CKSUM:
+      _rx_state = RX_SYNC;
+      if(b == _rx_cksum) { //Corrupt frames are dropped, the host times out and retries
+        _active = true;
+        handleFrame();
+      }
+      break;
+  }
+}
+
+/**
+ * True once the registry has received its first valid frame. From then on the link
+ * belongs to the protocol and text output should stop.
+ */
+bool paramRegistry::active() {
+  return _active;
+}
+
+/**
+ * Hash (FNV-1a) of the parameter table: struct size and every name, type and offset.
+ * Changes whenever fields are added, removed, renamed, retyped or reordered.
+ */
+uint32_t paramRegistry::layout() {
+  uint32_t h = 2166136261UL;
+  const char* c;
+
+  h = (h ^ (_size & 0xFF)) * 16777619UL;
+  h = (h ^ (_size >> 8)) * 16777619UL;
+  for(uint8_t id=0; id < _count; id++) {
+    for(c = _descs[id].name; *c != 0; c++) {
+      h = (h ^ (uint8_t)*c) * 16777619UL;
+    }
+    h = (h ^ _descs[id].type) * 16777619UL;
+    h = (h ^ (_descs[id].offset & 0xFF)) * 16777619UL;
+    h = (h ^ (_descs[id].offset >> 8)) * 16777619UL;
+  }
+  return h;
+}
+
+/**
+ * Fill the response payload with [status, id, type, value] for a parameter.
+ * Returns the payload length.
+ */
+uint8_t paramRegistry::putDesc(uint8_t id) {
+  const PARAM_DESC_T* d = desc(id);
+  uint32_t raw = 0;
+
+  _tx[3] = get(id, &raw);
+  _tx[4] = id;
+  _tx[5] = d != 0 ? d->type : 0;
+  memcpy(&_tx[6], &raw, sizeof(raw));
+  return 7;
+}
+
+void paramRegistry::handleFrame() {
+  uint32_t raw;
+  uint8_t len;
+  uint8_t name_len;
+  const PARAM_DESC_T* d;
+
+  switch(_rx_cmd) {
+    case PARAM_CMD_GET:
+      if(_rx_len != 1) {
+        _tx[3] = PARAM_ERR_LEN;
+        sendFrame(_rx_cmd, 1);
+        break;
+      }
+      sendFrame(_rx_cmd, putDesc(_rx[0]));
+      break;
+
+    case PARAM_CMD_SET:
+      if(_rx_len != 5) {
+        _tx[3] = PARAM_ERR_LEN;
+        sendFrame(_rx_cmd, 1);
+        break;
+      }
+      memcpy(&raw, &_rx[1], sizeof(raw));
+      len = putDesc(_rx[0]);
+      if(_tx[3] == PARAM_OK) {
+        _tx[3] = set(_rx[0], raw);
+        if(_tx[3] == PARAM_OK) {
+          memcpy(&_tx[6], &raw, sizeof(raw));
+        }
+      }
+      sendFrame(_rx_cmd, len);
+      break;
+
+    case PARAM_CMD_LIST:
+      for(uint8_t id=0; id < _count + _status_count; id++) {
+        d = desc(id);
+        len = putDesc(id);
+        memcpy(&_tx[3 + len], &d->min, sizeof(float));
+        len += sizeof(float);
+        memcpy(&_tx[3 + len], &d->max, sizeof(float));
+        len += sizeof(float);
+        name_len = strlen(d->name);
+        if(name_len > PARAM_NAME_LEN) {
+          name_len = PARAM_NAME_LEN;
+        }
+        memcpy(&_tx[3 + len], d->name, name_len);
+        len += name_len;
+        sendFrame(_rx_cmd, len);
+      }
+      break;
+
+    case PARAM_CMD_PERSIST:
+      _tx[3] = (_persist != 0 && _persist()) ? PARAM_OK : PARAM_ERR_PERSIST;
+      sendFrame(_rx_cmd, 1);
+      break;
+
+    default:
+      _tx[3] = PARAM_ERR_CMD;
+      sendFrame(_rx_cmd, 1);
+      break;
+  }
+}
+
+/**
+ * Wrap the payload already in _tx[3..] in a response frame and send it.
+ */
+void paramRegistry::sendFrame(uint8_t cmd, uint8_t len) {
+  uint8_t cksum;
+
+  _tx[0] = PARAM_RESP_SYNC;
+  _tx[1] = cmd | PARAM_RESP_FLAG;
+  _tx[2] = len;
+  cksum = _tx[1] ^ _tx[2];
+  for(int i=0; i < len; i++) {
+    cksum ^= _tx[3 + i];
+  }
+  _tx[3 + len] = cksum;
+
+  if(_write != 0) {
+    _write(_tx, len + 4);
+  }
+}
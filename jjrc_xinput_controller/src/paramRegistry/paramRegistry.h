@@ -0,0 +1,131 @@
+// Registry of runtime tunable parameters with a compact binary get/set/list/persist protocol.
+//
+// Parameters live in a caller owned struct, described by a table of PARAM_DESC_T
+//   (name, type, offset into the struct, allowed range). SETs are written to a staged copy
+//   of the struct; apply() copies the staged struct over the live one in one step, so all
+//   changes received during a loop iteration take effect together at the start of the next.
+//   No dynamic allocation.
+//
+// Frames (multi-byte values little endian, cksum = XOR of cmd, len and payload bytes):
+//   Request:  0xA5 cmd len payload[len] cksum
+//   Response: 0x5A cmd|0x80 len payload[len] cksum, payload[0] is a PARAM_STATUS_T
+//
+//   PARAM_CMD_GET     [id]          -> [status, id, type, value(4)]
+//   PARAM_CMD_SET     [id, value(4)]-> [status, id, type, value(4)]
+//   PARAM_CMD_LIST    []            -> one frame per parameter, then per status value:
+//                                      [status, id, type, value(4), min(4), max(4), name...]
+//   PARAM_CMD_PERSIST []            -> [status]
+//
+//   value is an int32 or float depending on type, min/max are always floats.
+//   GET/LIST report the staged value (what will be live from the next loop iteration).
+//
+// Status values (setupStatus()) are read-only counters the application exposes through the
+//   same GET/LIST commands. Their ids follow the parameters', GET/LIST report the current
+//   value and SET is refused with PARAM_ERR_READ_ONLY. They aren't staged or persisted and
+//   aren't part of layout().
+//
+//   Frames with a bad checksum are dropped without a response.
+//
+//   The link may be shared with plain text debug output. active() turns true once the first
+//   valid request frame is received, and the application must stop writing text to the link
+//   from then on, so after a host's first request everything it reads back is response frames.
+//   Text that happens to contain the sync byte can't activate the protocol by itself.
+//
+// layout() identifies the parameter table (names, types, offsets, struct size). Store it
+//   with persisted parameters and reject a stored record whose layout doesn't match.
+
+#ifndef paramRegistry_h
+#define paramRegistry_h
+
+#include <stdint.h>
+
+#define PARAM_REQ_SYNC  0xA5
+#define PARAM_RESP_SYNC 0x5A
+#define PARAM_RESP_FLAG 0x80
+#define PARAM_MAX_PAYLOAD 32 //Largest payload in either direction
+#define PARAM_NAME_LEN 16    //Longest parameter name sent by LIST
+
+enum PARAM_CMD_T {
+  PARAM_CMD_GET = 0x01,
+  PARAM_CMD_SET = 0x02,
+  PARAM_CMD_LIST = 0x03,
+  PARAM_CMD_PERSIST = 0x04
+};
+
+enum PARAM_STATUS_T {
+  PARAM_OK,
+  PARAM_ERR_ID,      //No parameter with that id
+  PARAM_ERR_RANGE,   //Value outside the parameter's min/max, not applied
+  PARAM_ERR_CMD,     //Unknown command
+  PARAM_ERR_LEN,     //Wrong payload length for the command
+  PARAM_ERR_PERSIST, //Persist callback missing or failed
+  PARAM_ERR_READ_ONLY //Status value, can't be set
+};
+
+enum PARAM_TYPE_T {
+  PARAM_INT32,
+  PARAM_FLOAT
+};
+
+struct PARAM_DESC_T {
+  const char* name;
+  uint8_t type;    //PARAM_TYPE_T
+  uint16_t offset; //offsetof() the field within the parameter struct
+  float min;
+  float max;
+};
+
+class paramRegistry {
+
+public:
+  paramRegistry();
+
+  void setup(const PARAM_DESC_T* descs, uint8_t count, void* live, void* staged, uint16_t size,
+      void (*write)(const uint8_t* buf, uint8_t len), bool (*persist)());
+  void setupStatus(const PARAM_DESC_T* descs, uint8_t count, const void* values);
+
+  uint8_t get(uint8_t id, uint32_t* raw);
+  uint8_t set(uint8_t id, uint32_t raw);
+  uint8_t stage(const void* values);
+  bool apply();
+  void receive(uint8_t b);
+  bool active();
+  uint32_t layout();
+
+private:
+  enum RX_STATE_T {
+    RX_SYNC,
+    RX_CMD,
+    RX_LEN,
+    RX_PAYLOAD,
+    RX_CKSUM
+  };
+
+  void handleFrame();
+  void sendFrame(uint8_t cmd, uint8_t len);
+  uint8_t putDesc(uint8_t id);
+  const PARAM_DESC_T* desc(uint8_t id);
+
+  const PARAM_DESC_T* _descs;
+  uint8_t _count;
+  const PARAM_DESC_T* _status_descs;
+  uint8_t _status_count;
+  const uint8_t* _status;
+  uint8_t* _live;
+  uint8_t* _staged;
+  uint16_t _size;
+  bool _dirty;
+  bool _active;
+  void (*_write)(const uint8_t* buf, uint8_t len);
+  bool (*_persist)();
+
+  RX_STATE_T _rx_state;
+  uint8_t _rx_cmd;
+  uint8_t _rx_len;
+  uint8_t _rx_pos;
+  uint8_t _rx_cksum;
+  uint8_t _rx[PARAM_MAX_PAYLOAD];
+  uint8_t _tx[PARAM_MAX_PAYLOAD + 4];
+};
+
+#endif
@@ -0,0 +1,108 @@
+// Parallel debouncer for up to 32 discrete inputs using vertical counters.
+
+#include "vDebounce.h"
+
+vDebounce::vDebounce() {
+  setup(0, 1, false);
+}
+
+/**
+ * initial - starting debounced level of each input
+ * samples - number of sample periods to debounce / lock out for (1 to VDEBOUNCE_MAX_SAMPLES)
+ * leadingEdge - true = report the first edge immediately, false = wait for the input to settle
+ */
+void vDebounce::setup(uint32_t initial, uint8_t samples, bool leadingEdge) {
+  _state = initial;
+  for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+    _count[i] = 0;
+  }
+  setSamples(samples);
+  _leadingEdge = leadingEdge;
+}
+
+void vDebounce::setSamples(uint8_t samples) {
+  if(samples < 1) {
+    samples = 1;
+  } else if(samples > VDEBOUNCE_MAX_SAMPLES) {
+    samples = VDEBOUNCE_MAX_SAMPLES;
+  }
+  _samples = samples;
+}
+
+void vDebounce::setLeadingEdge(bool leadingEdge) {
+  _leadingEdge = leadingEdge;
+}
+
+/**
+ * Returns a mask with a bit set for every input whose counter currently equals n.
+ */
+uint32_t vDebounce::countEquals(uint8_t n) {
+  uint32_t eq = 0xFFFFFFFF;
+
+  for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+    if(n & (1 << i)) {
+      eq &= _count[i];
+    } else {
+      eq &= ~_count[i];
+    }
+  }
+  return eq;
+}
+
+/**
+ * Feed in one raw sample of all inputs (call at a fixed rate).
+ * Returns a mask of the inputs whose debounced level changed on this sample.
+ */
+uint32_t vDebounce::update(uint32_t sample) {
+  uint32_t delta = sample ^ _state;
+  uint32_t changed;
+  uint32_t carry;
+  uint32_t t;
+
+  if(_leadingEdge) {
+    //Any non-zero counter means the input is inside its lockout window.
+    uint32_t locked = 0;
+    for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+      locked |= _count[i];
+    }
+
+    changed = delta & ~locked;
+
+    //Count lockout time for inputs that are locked or just changed.
+    carry = locked | changed;
+    for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+      t = _count[i];
+      _count[i] = t ^ carry;
+      carry &= t;
+    }
+
+    //Release the inputs whose lockout has expired.
+    t = countEquals(_samples);
+    for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+      _count[i] &= ~t;
+    }
+  } else {
+    //Count consecutive samples that disagree with the debounced level, reset on agreement.
+    carry = delta;
+    for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+      t = _count[i];
+      _count[i] = (t ^ carry) & delta;
+      carry &= t;
+    }
+
+    changed = delta & countEquals(_samples);
+    for(int i=0; i < VDEBOUNCE_PLANES; i++) {
+      _count[i] &= ~changed;
+    }
+  }
+
+  _state ^= changed;
+  return changed;
+}
+
+/**
+ * Current debounced level of all inputs.
+ */
+uint32_t vDebounce::read() {
+  return _state;
+}
@@ -0,0 +1,42 @@
+// Parallel debouncer for up to 32 discrete inputs using vertical counters.
+//   Each bit of the sample word is one input. Every input gets its own counter,
+//   stored one bit-plane per word, so a single update() debounces all of them
+//   in a fixed handful of bitwise operations regardless of how many are in use.
+//
+// Two modes:
+//   Integrating  - a change is reported once the input has read the new level
+//                  for 'samples' consecutive updates.
+//   Leading edge - a change is reported on the first sample that differs, then
+//                  the input is locked out for 'samples' updates to ride out bounce.
+//
+// Has no Arduino dependencies.
+
+#ifndef vDebounce_h
+#define vDebounce_h
+
+#include <stdint.h>
+
+#define VDEBOUNCE_PLANES 5                               //Bits per counter
+#define VDEBOUNCE_MAX_SAMPLES ((1 << VDEBOUNCE_PLANES) - 1) //Largest count the counters can hold
+
+class vDebounce {
+
+public:
+  vDebounce();
+
+  void setup(uint32_t initial, uint8_t samples, bool leadingEdge);
+  uint32_t update(uint32_t sample);
+  uint32_t read();
+  void setSamples(uint8_t samples);
+  void setLeadingEdge(bool leadingEdge);
+
+private:
+  uint32_t countEquals(uint8_t n);
+
+  volatile uint32_t _state;           //Debounced level of each input
+  uint32_t _count[VDEBOUNCE_PLANES];  //Vertical counters, _count[0] is the LSB plane
+  uint8_t _samples;
+  bool _leadingEdge;
+};
+
+#endif